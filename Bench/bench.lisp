@@ -0,0 +1,18 @@
+; Recursive integer arithmetic
+(define fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+(fib 22)
+(define tak (x y z) (if (< y x) (tak (tak (- x 1) y z) (tak (- y 1) z x) (tak (- z 1) x y)) z))
+(tak 18 12 6)
+; List construction and insertion sort
+(define mod (m n) (- m (* n (/ m n))))
+(define randlist (n seed)
+  (if (= n 0) '()
+    (cons (mod seed 1000) (randlist (- n 1) (mod (+ (* seed 75) 74) 65537)))))
+(define insert (x l)
+  (if (null? l) (cons x '())
+    (if (< x (car l)) (cons x l) (cons (car l) (insert x (cdr l))))))
+(define isort (l) (if (null? l) '() (insert (car l) (isort (cdr l)))))
+(define length (l) (if (null? l) 0 (+ 1 (length (cdr l)))))
+(length (isort (randlist 600 42)))
+(car (isort (randlist 600 42)))
+quit
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+//  This file is part of
+/// ---     Timothy Budd's Kamin Interpreters in C++
+// -----------------------------------------------------------------------------
+/// Title: Arbitrary-precision integers
+///  Description:
+//    BigInteger holds integers too large for a machine word as a sign and a
+//    magnitude of 32-bit limbs, least significant first.  It is used by
+//    IntegerExpression only when machine-word arithmetic overflows.
+// -----------------------------------------------------------------------------
+
+#ifndef BigInteger_H
+#define BigInteger_H
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+/// BigInteger
+// -----------------------------------------------------------------------------
+class BigInteger
+{
+    //- Limbs of the magnitude, least significant first, with no leading zeros
+    std::vector<unsigned int> limbs_;
+
+    //- Sign, zero has no limbs and is never negative
+    bool negative_;
+
+    //- Number of limbs above which multiplication uses Karatsuba's method
+    static const std::size_t karatsubaThreshold = 32;
+
+    // Magnitude arithmetic
+
+    //- Compare magnitudes returning -1, 0 or 1
+    static int compareMagnitude
+    (
+        const std::vector<unsigned int>&,
+        const std::vector<unsigned int>&
+    );
+
+    //- Return the sum of the magnitudes
+    static std::vector<unsigned int> addMagnitude
+    (
+        const std::vector<unsigned int>&,
+        const std::vector<unsigned int>&
+    );
+
+    //- Return the difference of the magnitudes, the first must not be less
+    static std::vector<unsigned int> subtractMagnitude
+    (
+        const std::vector<unsigned int>&,
+        const std::vector<unsigned int>&
+    );
+
+    //- Return the product of the magnitudes
+    static std::vector<unsigned int> multiplyMagnitude
+    (
+        const std::vector<unsigned int>&,
+        const std::vector<unsigned int>&
+    );
+
+    //- Return the quotient of the magnitudes, setting the remainder
+    static std::vector<unsigned int> divideMagnitude
+    (
+        const std::vector<unsigned int>&,
+        const std::vector<unsigned int>&,
+        std::vector<unsigned int>& remainder
+    );
+
+    //- Remove leading zero limbs and the sign of zero
+    void normalise();
+
+    //- Add or subtract the other value
+    BigInteger addSigned(const BigInteger&, const bool negate) const;
+
+public:
+
+    //- Construct zero
+    BigInteger()
+    :
+        negative_(false)
+    {}
+
+    //- Construct from a machine integer
+    explicit BigInteger(long);
+
+    //- Construct from a string of decimal digits
+    BigInteger(const std::string& digits, const bool negative);
+
+    //- Does the value fit in a long?
+    bool fitsLong() const;
+
+    //- Return the value as a long, which must fit
+    long toLong() const;
+
+    //- Return the decimal representation
+    std::string toString() const;
+
+    //- Compare returning -1, 0 or 1
+    int compare(const BigInteger&) const;
+
+    // Arithmetic
+
+    BigInteger operator+(const BigInteger&) const;
+    BigInteger operator-(const BigInteger&) const;
+    BigInteger operator*(const BigInteger&) const;
+
+    //- Quotient truncated towards zero, the divisor must not be zero
+    BigInteger operator/(const BigInteger&) const;
+};
+///- BigInteger
+
+// -----------------------------------------------------------------------------
+#endif // BigInteger_H
+// -----------------------------------------------------------------------------
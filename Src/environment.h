@@ -6,6 +6,11 @@
 ///  Description:
 //    Environment holds the symbols, values and link to parent environment.
 //    Env is a reference-counting wrapper around Environment for GC
+//
+//    An environment without a parent is shared by the threads evaluating
+//    futures, so while the thread is concurrent it is locked for reading
+//    by lookup and for writing by add, set and define, see
+//    Interpreter::globalsMutex
 // -----------------------------------------------------------------------------
 
 #ifndef Environment_H
@@ -13,6 +18,8 @@
 
 #include "list.h"
 
+#include <shared_mutex>
+
 // -----------------------------------------------------------------------------
 /// Forward declarations
 // -----------------------------------------------------------------------------
@@ -46,6 +53,22 @@ class Environment
     //- Link to parent environment
     Environment* parent_;
 
+    //- Holds the parent if it is the frame of a call, which closures
+    //  created in the call may outlive.  Environments without a parent
+    //  belong to the interpreter and are not held.
+    Expr frame_;
+
+    //- Return the mutex to hold if the environment is shared with other
+    //  threads, otherwise 0
+    std::shared_mutex* sharedMutex() const;
+
+    //- Return the cell of the values list of this environment holding the
+    //  value of the symbol, 0 if the symbol is not defined here
+    ListNode* cell(const Symbol&);
+
+    //- Add symbol with expression without locking
+    void prepend(Symbol*, Expression*);
+
 public:
 
     //- Construct from components
@@ -65,6 +88,16 @@ public:
 
     //- Set symbol to expression in the environment
     void set(Symbol*, Expression*);
+
+    //- Define symbol as expression in this environment, replacing its
+    //  value if it is already defined here.  A definition which shadows a
+    //  function defined in an enclosing environment starts a new generation
+    //  of the interpreter, see OptimizedExpression.
+    void define(Symbol*, Expression*);
+
+    //- Return the cell of the values list holding the value of the symbol,
+    //  0 if the symbol is not defined
+    ListNode* binding(const Symbol&);
 };
 ///- Environment
 
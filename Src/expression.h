@@ -6,11 +6,16 @@
 ///  Description:
 //    Expression is the reference counted base-class for all expressions
 //    Expr is a reference-counting wrapper around Expression for GC
+//
+//    Reference counts are updated with plain loads and stores unless the
+//    thread is evaluating concurrently with other threads, see
+//    Expression::setConcurrent
 // -----------------------------------------------------------------------------
 
 #ifndef Expression_H
 #define Expression_H
 
+#include <atomic>
 #include <string>
 
 // -----------------------------------------------------------------------------
@@ -19,12 +24,16 @@
 class Environment;
 class Expression;
 class IntegerExpression;
+class BigInteger;
 class Symbol;
 class ListNode;
 class Function;
 class Environment;
 class APLValue;
+class Object;
 class Method;
+class InstanceVariable;
+class OptimizedExpression;
 class PrologValue;
 class Continuation;
 
@@ -79,15 +88,90 @@ public:
 class Expression
 {
     //- The reference-count for GC
-    mutable int referenceCount;
+    mutable std::atomic<int> referenceCount;
+
+    //- The number of expressions constructed by all threads, reported by
+    //  the benchmarks
+    inline static std::atomic<long> nConstructed_ = 0;
+
+    //- Are the expressions used by this thread shared with other threads?
+    inline static thread_local bool concurrent_ = false;
+
+    //- Increment the reference count
+    void reference() const
+    {
+        if (concurrent_)
+        {
+            referenceCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            referenceCount.store
+            (
+                referenceCount.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed
+            );
+        }
+    }
+
+    //- Decrement the reference count, return true if it is now 0
+    bool unreference() const
+    {
+        if (concurrent_)
+        {
+            return
+                referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        int count = referenceCount.load(std::memory_order_relaxed) - 1;
+        referenceCount.store(count, std::memory_order_relaxed);
+        return count == 0;
+    }
+
+    //- Increment the reference count unless it is 0, return true if it was
+    //  incremented
+    bool tryReference() const
+    {
+        int count = referenceCount.load(std::memory_order_relaxed);
+        while
+        (
+            count > 0
+         && !referenceCount.compare_exchange_weak(count, count + 1)
+        )
+        {}
+        return count > 0;
+    }
 
 public:
 
     friend class Expr;
+    friend class HashConsTable;
 
     //- Construct null
     Expression();
 
+    //- Construct copy, which is not yet referenced
+    Expression(const Expression&);
+
+    //- Return the number of expressions constructed so far
+    static long nConstructed()
+    {
+        return nConstructed_.load(std::memory_order_relaxed);
+    }
+
+    //- Update reference counts on this thread atomically while its
+    //  expressions may be used by other threads
+    static void setConcurrent(const bool c)
+    {
+        concurrent_ = c;
+    }
+
+    //- Are reference counts updated atomically on this thread?
+    static bool concurrent()
+    {
+        return concurrent_;
+    }
+
     //- Delete according to reference counts
     virtual ~Expression();
 
@@ -105,7 +189,10 @@ public:
     virtual ListNode* isList();
     virtual Environment* isEnvironment();
     virtual APLValue* isAPLValue();
+    virtual Object* isObject();
     virtual Method* isMethod();
+    virtual InstanceVariable* isInstanceVariable();
+    virtual OptimizedExpression* isOptimized();
     virtual Environment* isCluster();
     virtual PrologValue* isPrologValue();
     virtual Continuation* isContinuation();
@@ -115,31 +202,61 @@ public:
 
 // -----------------------------------------------------------------------------
 /// IntegerExpression
+//    Integers are held as a machine word, promoted to a BigInteger only when
+//    the value does not fit
 // -----------------------------------------------------------------------------
 class IntegerExpression
 :
     public Expression
 {
-    //- The integer value
-    int value_;
+    //- The integer value if small
+    long value_;
+
+    //- The integer value if it does not fit in value_, otherwise 0
+    BigInteger* big_;
 
 public:
 
-    //- Construct
-    IntegerExpression(const int v)
-    {
-        value_ = v;
-    }
+    //- Construct from machine integer
+    IntegerExpression(const long v)
+    :
+        value_(v),
+        big_(0)
+    {}
+
+    //- Construct from arbitrary-precision integer
+    IntegerExpression(const BigInteger&);
+
+    //- Destructor
+    virtual ~IntegerExpression();
 
     //- Specialised type predicate
     virtual IntegerExpression* isInteger();
 
-    //- Return the integer value
-    int val()
+    //- Is the value held as a machine integer?
+    int isSmall() const
+    {
+        return big_ == 0;
+    }
+
+    //- Is the value zero?
+    int isZero() const
+    {
+        return big_ == 0 && value_ == 0;
+    }
+
+    //- Return the integer value, which must be small
+    long val() const
     {
         return value_;
     }
 
+    //- Return the integer value as an arbitrary-precision integer
+    BigInteger big() const;
+
+    //- Compare returning -1, 0 or 1
+    int compare(const IntegerExpression&) const;
+
     //- Print
     virtual void print();
 
@@ -184,7 +301,7 @@ public:
     int operator==(const char*) const;
 
     //- Return the symbol's name
-    const std::string name() const
+    const std::string& name() const
     {
         return name_;
     }
@@ -16,6 +16,75 @@
 /// Forward declarations
 // -----------------------------------------------------------------------------
 class ListNode;
+class Optimizer;
+
+// -----------------------------------------------------------------------------
+/// Arguments
+//    The evaluated arguments of a function call held in a small inline array
+//    so that calls to primitives need not allocate.  Calls with more than
+//    nInline arguments overflow to an array on the free-store.
+// -----------------------------------------------------------------------------
+class Arguments
+{
+    //- Number of arguments held without allocation
+    static const int nInline = 4;
+
+    //- The inline arguments
+    Expr inline_[nInline];
+
+    //- The arguments beyond nInline
+    Expr* overflow_;
+
+    //- Capacity of the overflow array
+    int capacity_;
+
+    //- Number of arguments
+    int size_;
+
+    //- Disallow copy and assignment
+    Arguments(const Arguments&);
+    void operator=(const Arguments&);
+
+public:
+
+    //- Construct empty
+    Arguments()
+    :
+        overflow_(0),
+        capacity_(0),
+        size_(0)
+    {}
+
+    //- Destructor
+    ~Arguments()
+    {
+        delete[] overflow_;
+    }
+
+    //- Return the number of arguments
+    int size() const
+    {
+        return size_;
+    }
+
+    //- Return argument i
+    Expression* operator[](const int i)
+    {
+        return i < nInline ? inline_[i]() : overflow_[i - nInline]();
+    }
+
+    //- Append a null argument and return it to be set
+    Expr& append();
+
+    //- Return the arguments as a new list
+    ListNode* list();
+};
+///- Arguments
+
+//- Evaluate the arguments of a call into the argument vector, return 0 if
+//  one of them could not be evaluated
+int evalArgs(Arguments&, ListNode* args, Environment*);
+
 
 // -----------------------------------------------------------------------------
 /// Function
@@ -32,6 +101,11 @@ public:
     //- Apply function to given list in given environment and return result
     virtual void apply(Expr& result, ListNode*, Environment*);
 
+    //- Apply function to the evaluated arguments in given environment
+    //  and return result.  By default the arguments are converted into a
+    //  list and passed to applyWithArgs.
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
     //- Apply function with arguments to given list in given environment
     //  and return result
     virtual void applyWithArgs(Expr&, ListNode*, Environment*);
@@ -39,6 +113,11 @@ public:
     //- isClosure is recognized only by functions
     virtual int isClosure();
 
+    //- Set target to the call of this function optimised when the calling
+    //  function is defined, or to 0 if the call is not to be rewritten,
+    //  which is the default
+    virtual void optimize(Expr& target, Optimizer&, ListNode* call);
+
     //- Print
     virtual void print();
 };
@@ -72,9 +151,12 @@ public:
     //- Apply function to given list in given environment and return result
     virtual void apply(Expr&, ListNode*, Environment*);
 
-    //- Apply function with arguments to given list in given environment
+    //- Apply function to the evaluated arguments in given environment
     //  and return result
-    virtual void applyWithArgs(Expr&, ListNode*, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
+    //- Optimise the arguments of the call
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- UnaryFunction
 
@@ -106,9 +188,12 @@ public:
     //- Apply function to given list in given environment and return result
     virtual void apply(Expr&, ListNode*, Environment*);
 
-    //- Apply function with arguments to given list in given environment
+    //- Apply function to the evaluated arguments in given environment
     //  and return result
-    virtual void applyWithArgs(Expr&, ListNode*, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
+    //- Optimise the arguments of the call
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- BinaryFunction
 
@@ -120,20 +205,40 @@ class IntegerBinaryFunction
 :
     public BinaryFunction
 {
-    //- The function pointer
-    int (*function_) (int, int);
+    //- The arithmetic function pointer
+    IntegerExpression* (*function_) (IntegerExpression*, IntegerExpression*);
+
+    //- The relational function pointer, the result is the integer 0 or 1
+    int (*relation_) (IntegerExpression*, IntegerExpression*);
 
 public:
 
-    //- Construct from function pointer
-    IntegerBinaryFunction(int (*thefun) (int, int))
-    {
-        function_ = thefun;
-    }
+    //- Construct from arithmetic function pointer
+    IntegerBinaryFunction
+    (
+        IntegerExpression* (*thefun) (IntegerExpression*, IntegerExpression*)
+    )
+    :
+        function_(thefun),
+        relation_(0)
+    {}
 
-    //- Apply function with arguments to given list in given environment
+    //- Construct from relational function pointer
+    IntegerBinaryFunction
+    (
+        int (*therel) (IntegerExpression*, IntegerExpression*)
+    )
+    :
+        function_(0),
+        relation_(therel)
+    {}
+
+    //- Apply function to the evaluated arguments in given environment
     //  and return result
-    virtual void applyWithArgs(Expr&, ListNode*, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
+    //- Optimise the arguments of the call and fold it if they are constant
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- IntegerBinaryFunction
 
@@ -146,19 +251,22 @@ class BooleanBinaryFunction
     public BinaryFunction
 {
     //- The function pointer
-    int (*function_) (int, int);
+    int (*function_) (IntegerExpression*, IntegerExpression*);
 
 public:
 
     //- Construct from function pointer
-    BooleanBinaryFunction(int (*thefun) (int, int))
+    BooleanBinaryFunction
+    (
+        int (*thefun) (IntegerExpression*, IntegerExpression*)
+    )
     {
         function_ = thefun;
     }
 
-    //- Apply function with arguments to given list in given environment
+    //- Apply function to the evaluated arguments in given environment
     //  and return result
-    virtual void applyWithArgs(Expr&, ListNode*, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
 };
 ///- BooleanBinaryFunction
 
@@ -176,6 +284,9 @@ protected:
     Expr body_;
     Environment* context_;
 
+    //- Evaluate the body with the arguments bound to the argument names
+    void evalBody(Expr&, ListNode* args);
+
 public:
 
     //- Construct from components
@@ -184,12 +295,37 @@ public:
     //- Destructor
     virtual ~UserFunction();
 
+    //- Return the names of the arguments
+    ListNode* argNames()
+    {
+        return argNames_;
+    }
+
+    //- Return the body
+    Expression* body()
+    {
+        return body_();
+    }
+
+    //- Return the environment in which the function was defined
+    Environment* context()
+    {
+        return context_;
+    }
+
+    //- Apply function to the evaluated arguments in given environment
+    //  and return result
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
     //- Apply function with arguments to given list in given environment
     //  and return result
     virtual void applyWithArgs(Expr&, ListNode*, Environment*);
 
     //- Is this user-function a closure?
     virtual int isClosure();
+
+    //- Inline the call if the body calls only primitives
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- UserFunction
 
@@ -0,0 +1,337 @@
+// -----------------------------------------------------------------------------
+//  This file is part of
+/// ---     Timothy Budd's Kamin Interpreters in C++
+// -----------------------------------------------------------------------------
+/// Title: Interpreter
+///  Description:
+//    Interpreter holds the state of one interpreter session: the global,
+//    value-operation and command environments, the reader, the boolean
+//    values, the hash-consing table and the input and output streams.
+//    Several interpreters may exist in one process; the interpreter in use on
+//    the current thread is selected by an Interpreter::Activation and its
+//    state is reached through the free functions emptyList(),
+//    globalEnvironment(), valueOps(), commands(), trueExpr(), falseExpr(),
+//    input(), output() and errorOutput().
+//
+//    Expressions are reference counted without synchronisation so the
+//    expressions of an interpreter must only be used by one thread at a time.
+// -----------------------------------------------------------------------------
+
+#ifndef Interpreter_H
+#define Interpreter_H
+
+#include "environment.h"
+
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <shared_mutex>
+
+// -----------------------------------------------------------------------------
+/// Forward declarations
+// -----------------------------------------------------------------------------
+class ReaderClass;
+
+// -----------------------------------------------------------------------------
+/// Interpreter
+// -----------------------------------------------------------------------------
+class Interpreter
+{
+    //- The canonical lists, declared first so that it is destroyed after
+    //  the nodes it refers to
+    HashConsTable hashConsTable_;
+
+    //- Input stream read by the reader
+    std::istream& input_;
+
+    //- Output stream for results and prompts
+    std::ostream& output_;
+
+    //- Output stream for error messages
+    std::ostream& errorOutput_;
+
+    //- The empty list
+    List emptyList_;
+
+    //- Global symbols
+    Env globalEnvironment_;
+
+    //- Built-in operations
+    Env valueOps_;
+
+    //- Top level commands
+    Env commands_;
+
+    //- The values of true and false, set by the language initialisation
+    Expr trueExpr_;
+    Expr falseExpr_;
+
+    //- Additional state owned by the language initialisation
+    Expr languageState_;
+
+    //- The language-specific reader, set by the language initialisation
+    ReaderClass* reader_;
+
+    //- Serialises output from the threads evaluating futures
+    std::recursive_mutex outputMutex_;
+
+    //- Protects the environments without a parent while futures are
+    //  evaluated, see Environment
+    std::shared_mutex globalsMutex_;
+
+    //- Are definitions optimised?
+    int optimizing_;
+
+    //- Incremented when a definition shadows a function of an enclosing
+    //  environment, invalidating the optimised definitions
+    long generation_;
+
+    //- Number of futures not yet released by the thread pool
+    int nTasks_;
+
+    //- Protects nTasks_
+    std::mutex tasksMutex_;
+
+    //- Signalled when nTasks_ drops to zero
+    std::condition_variable tasksReleased_;
+
+    //- The interpreter active on this thread
+    inline static thread_local Interpreter* current_ = 0;
+
+    //- Disallow copy and assignment
+    Interpreter(const Interpreter&);
+    void operator=(const Interpreter&);
+
+public:
+
+    // -------------------------------------------------------------------------
+    /// Activation
+    //    Makes an interpreter current on this thread for its lifetime,
+    //    restoring the previously current interpreter on destruction
+    // -------------------------------------------------------------------------
+    class Activation
+    {
+        //- The interpreter to restore
+        Interpreter* previous_;
+
+        //- Disallow copy and assignment
+        Activation(const Activation&);
+        void operator=(const Activation&);
+
+    public:
+
+        //- Make the interpreter current
+        Activation(Interpreter& interpreter)
+        :
+            previous_(current_)
+        {
+            current_ = &interpreter;
+        }
+
+        //- Restore the previous interpreter
+        ~Activation()
+        {
+            current_ = previous_;
+        }
+    };
+    ///- Activation
+
+    //- Construct reading from in and writing to out and err and run the
+    //  language initialisation
+    Interpreter(std::istream& in, std::ostream& out, std::ostream& err);
+
+    //- Destructor
+    ~Interpreter();
+
+    //- Return the interpreter active on this thread
+    static Interpreter& current()
+    {
+        return *current_;
+    }
+
+    // Access
+
+    std::istream& input()
+    {
+        return input_;
+    }
+
+    std::ostream& output()
+    {
+        return output_;
+    }
+
+    std::ostream& errorOutput()
+    {
+        return errorOutput_;
+    }
+
+    ListNode* emptyList()
+    {
+        return emptyList_;
+    }
+
+    Environment* globalEnvironment()
+    {
+        return globalEnvironment_;
+    }
+
+    Environment* valueOps()
+    {
+        return valueOps_;
+    }
+
+    Environment* commands()
+    {
+        return commands_;
+    }
+
+    Expression* trueExpr()
+    {
+        return trueExpr_();
+    }
+
+    Expression* falseExpr()
+    {
+        return falseExpr_();
+    }
+
+    Expression* languageState()
+    {
+        return languageState_();
+    }
+
+    HashConsTable& hashConsTable()
+    {
+        return hashConsTable_;
+    }
+
+    //- Are definitions optimised?
+    int optimizing() const
+    {
+        return optimizing_;
+    }
+
+    //- Return the generation of the definitions
+    long generation() const
+    {
+        return generation_;
+    }
+
+    //- Return the mutex to hold while writing output which may interleave
+    //  with output from futures
+    std::recursive_mutex& outputMutex()
+    {
+        return outputMutex_;
+    }
+
+    //- Return the mutex protecting the global, value-operation and command
+    //  environments from concurrent modification
+    std::shared_mutex& globalsMutex()
+    {
+        return globalsMutex_;
+    }
+
+    // Edit
+
+    //- Set the values of true and false
+    void setBooleans(Expression* t, Expression* f)
+    {
+        trueExpr_ = t;
+        falseExpr_ = f;
+    }
+
+    //- Set the additional language state
+    void setLanguageState(Expression* s)
+    {
+        languageState_ = s;
+    }
+
+    //- Enable or disable the optimisation of definitions
+    void setOptimizing(const int on)
+    {
+        optimizing_ = on;
+    }
+
+    //- Start a new generation of definitions
+    void newGeneration()
+    {
+        generation_++;
+    }
+
+    // Evaluation, the interpreter must be active
+
+    //- Read, evaluate and print one statement, return 0 on quit
+    int readEvalPrint();
+
+    //- Read, evaluate and print statements until quit
+    void run();
+
+    // Futures
+
+    //- Record that a future is queued on the thread pool and update
+    //  reference counts on this thread atomically
+    void taskSubmitted();
+
+    //- Record that the thread pool has released a future
+    void taskReleased();
+
+    //- Wait until the thread pool has released all the futures and return
+    //  this thread to plain reference counting
+    void waitForTasks();
+};
+///- Interpreter
+
+
+// -----------------------------------------------------------------------------
+/// Access to the state of the current interpreter
+// -----------------------------------------------------------------------------
+
+inline ListNode* emptyList()
+{
+    return Interpreter::current().emptyList();
+}
+
+inline Environment* globalEnvironment()
+{
+    return Interpreter::current().globalEnvironment();
+}
+
+inline Environment* valueOps()
+{
+    return Interpreter::current().valueOps();
+}
+
+inline Environment* commands()
+{
+    return Interpreter::current().commands();
+}
+
+inline Expression* trueExpr()
+{
+    return Interpreter::current().trueExpr();
+}
+
+inline Expression* falseExpr()
+{
+    return Interpreter::current().falseExpr();
+}
+
+inline std::istream& input()
+{
+    return Interpreter::current().input();
+}
+
+inline std::ostream& output()
+{
+    return Interpreter::current().output();
+}
+
+inline std::ostream& errorOutput()
+{
+    return Interpreter::current().errorOutput();
+}
+
+// -----------------------------------------------------------------------------
+#endif // Interpreter_H
+// -----------------------------------------------------------------------------
@@ -12,6 +12,10 @@
 
 #include "reader.h"
 #include "function.h"
+#include "list.h"
+
+#include <cstddef>
+#include <mutex>
 
 // -----------------------------------------------------------------------------
 /// LispReader
@@ -53,19 +57,20 @@ protected:
 
 // -----------------------------------------------------------------------------
 /// Arithmetic functions
+//    Machine-word arithmetic is checked and promoted to BigInteger on overflow
 // -----------------------------------------------------------------------------
-int PlusFunction(int, int);
-int MinusFunction(int, int);
-int TimesFunction(int, int);
-int DivideFunction(int, int);
+IntegerExpression* PlusFunction(IntegerExpression*, IntegerExpression*);
+IntegerExpression* MinusFunction(IntegerExpression*, IntegerExpression*);
+IntegerExpression* TimesFunction(IntegerExpression*, IntegerExpression*);
+IntegerExpression* DivideFunction(IntegerExpression*, IntegerExpression*);
 
 // -----------------------------------------------------------------------------
 /// Relational functions
 // -----------------------------------------------------------------------------
 void EqualFunction(Expr&, Expression*, Expression*);
-int IntEqualFunction(int, int);
-int LessThanFunction(int, int);
-int GreaterThanFunction(int, int);
+int IntEqualFunction(IntegerExpression*, IntegerExpression*);
+int LessThanFunction(IntegerExpression*, IntegerExpression*);
+int GreaterThanFunction(IntegerExpression*, IntegerExpression*);
 
 // -----------------------------------------------------------------------------
 //      We can do Car and Cdr because they all evaluate their arguments
@@ -76,6 +81,21 @@ void CarFunction(Expr&, Expression*);
 void CdrFunction(Expr&, Expression*);
 void ConsFunction(Expr&, Expression*, Expression*);
 
+// -----------------------------------------------------------------------------
+/// Memoisation and hash-consing
+//    memo returns a function which caches the results of the given function
+//    keyed on the structure of its arguments.  hash-cons enables or disables
+//    the sharing of structurally equal lists built by cons and quotation.
+// -----------------------------------------------------------------------------
+void MemoFunction(Expr&, Expression*);
+void HashConsFunction(Expr&, Expression*);
+
+// -----------------------------------------------------------------------------
+/// Optimisation
+//    optimize enables or disables the optimisation of function definitions
+// -----------------------------------------------------------------------------
+void OptimizeFunction(Expr&, Expression*);
+
 // -----------------------------------------------------------------------------
 /// BooleanUnary
 // -----------------------------------------------------------------------------
@@ -90,11 +110,82 @@ public:
     {
         function_ = f;
     }
-    virtual void applyWithArgs(Expr& target, ListNode* args, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
 };
 ///- BooleanUnary
 
 
+// -----------------------------------------------------------------------------
+/// MemoisedFunction
+//    Wraps a user-defined function with a hash table of the results of
+//    previous calls keyed on the structural hash of the arguments
+// -----------------------------------------------------------------------------
+class MemoisedFunction
+:
+    public Function
+{
+    //- A cached call
+    struct Entry
+    {
+        //- The arguments of the call
+        List args_;
+
+        //- The result
+        Expr value_;
+
+        //- The hash of the arguments
+        std::size_t hash_;
+
+        //- The next entry in the bucket
+        Entry* next_;
+    };
+
+    //- The wrapped function
+    Expr function_;
+
+    //- Heads of the bucket chains
+    Entry** buckets_;
+
+    //- Number of buckets, a power of two
+    std::size_t nBuckets_;
+
+    //- Number of cached calls
+    std::size_t size_;
+
+    //- Protects the table from concurrent calls by futures
+    std::mutex mutex_;
+
+    //- Disallow copy and assignment
+    MemoisedFunction(const MemoisedFunction&);
+    void operator=(const MemoisedFunction&);
+
+    //- Return the hash of the arguments
+    static std::size_t hash(Arguments&);
+
+    //- Are the cached arguments structurally equal to the given arguments?
+    static int equal(ListNode*, Arguments&);
+
+    //- Double the number of buckets
+    void grow();
+
+public:
+
+    //- Construct wrapping the given function
+    MemoisedFunction(Function*);
+
+    //- Destructor
+    virtual ~MemoisedFunction();
+
+    //- Apply the function to the evaluated arguments unless the result for
+    //  equal arguments is cached
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
+    //- Is the wrapped function a closure?
+    virtual int isClosure();
+};
+///- MemoisedFunction
+
+
 // -----------------------------------------------------------------------------
 /// Predicates
 // -----------------------------------------------------------------------------
@@ -134,6 +225,10 @@ class IfStatement
 {
 public:
     virtual void apply(Expr&, ListNode*, Environment*);
+
+    //- Optimise the parts, pruning the branch not taken if the condition
+    //  is constant
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- IfStatement
 
@@ -147,6 +242,9 @@ class WhileStatement
 {
 public:
     virtual void apply(Expr&, ListNode*, Environment*);
+
+    //- Optimise the condition and body
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- WhileStatement
 
@@ -160,6 +258,9 @@ class SetStatement
 {
 public:
     virtual void apply(Expr&, ListNode*, Environment*);
+
+    //- Optimise the value
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- SetStatement
 
@@ -172,7 +273,10 @@ class BeginStatement
     public Function
 {
 public:
-    virtual void applyWithArgs(Expr&, ListNode*, Environment*);
+    virtual void applyWithArguments(Expr&, Arguments&, Environment*);
+
+    //- Optimise the statements
+    virtual void optimize(Expr&, Optimizer&, ListNode*);
 };
 ///- BeginStatement
 
@@ -13,6 +13,10 @@
 
 #include "expression.h"
 
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
 // -----------------------------------------------------------------------------
 /// List
 // -----------------------------------------------------------------------------
@@ -20,6 +24,10 @@ class ListNode
 :
     public Expression
 {
+    //- Is this the canonical node of a hash-consing table?
+    //  Declared first so that it occupies the padding of Expression
+    bool interned_;
+
     //- The head element of cons-cell
     Expr head_;
 
@@ -27,6 +35,8 @@ class ListNode
     Expr tail_;
 
 
+    friend class HashConsTable;
+
 public:
 
     //- Construct from the head and tail elements
@@ -50,12 +60,25 @@ public:
     //- Return the tail
     ListNode* tail();
 
+    //- Return the tail expression without converting it to a list
+    //  (it may be an unevaluated thunk)
+    Expression* rest()
+    {
+        return tail_();
+    }
+
     //- Specialised type predicate
     virtual ListNode* isList();
 
     //- Empty list predicate
     int isNil();
 
+    //- Is this the canonical node of a hash-consing table?
+    int interned() const
+    {
+        return interned_;
+    }
+
     //- Return the number of elements in the list O(1)
     int length();
 
@@ -104,6 +127,78 @@ public:
 ///- List
 
 
+// -----------------------------------------------------------------------------
+/// HashConsTable
+//    Weak table of the canonical list nodes of an interpreter.  While
+//    hash-consing is enabled lists built by cons share a single node for each
+//    distinct head and tail, so two lists are structurally equal only if they
+//    are the same node.  Nodes remove themselves from the table when deleted.
+// -----------------------------------------------------------------------------
+class HashConsTable
+{
+    //- The canonical nodes keyed by the hash of their head and tail
+    std::unordered_multimap<std::size_t, ListNode*> nodes_;
+
+    //- Are new lists to be hash-consed?
+    int enabled_;
+
+    //- Protects the table from concurrent use by futures, recursive because
+    //  deleting nodes while interning may remove nodes
+    std::recursive_mutex mutex_;
+
+    //- Disallow copy and assignment
+    HashConsTable(const HashConsTable&);
+    void operator=(const HashConsTable&);
+
+    //- Set target to the canonical form of a head or tail element
+    void canonical(Expr& target, Expression*);
+
+    //- Return the hash of a node with the given canonical head and tail
+    static std::size_t hash(Expression* head, Expression* tail);
+
+public:
+
+    //- Construct empty and disabled
+    HashConsTable()
+    :
+        enabled_(0)
+    {}
+
+    //- Is hash-consing enabled?
+    int enabled() const
+    {
+        return enabled_;
+    }
+
+    //- Enable or disable hash-consing of new lists
+    void enable(const int e)
+    {
+        enabled_ = e;
+    }
+
+    //- Set target to the canonical node with the given head and tail
+    void cons(Expr& target, Expression* head, Expression* tail);
+
+    //- Set target to the canonical copy of the list
+    void intern(Expr& target, ListNode*);
+
+    //- Remove the node which is being deleted
+    void remove(ListNode*);
+};
+///- HashConsTable
+
+
+// -----------------------------------------------------------------------------
+/// Structural equality
+//    Integers are equal by value, symbols by name and lists element by
+//    element.  Any other expression is only equal to itself.
+// -----------------------------------------------------------------------------
+int structurallyEqual(Expression*, Expression*);
+
+//- Return a hash consistent with structurallyEqual
+std::size_t structuralHash(Expression*);
+
+
 // -----------------------------------------------------------------------------
 /// Member functions for class ListNode
 // -----------------------------------------------------------------------------
@@ -0,0 +1,294 @@
+// -----------------------------------------------------------------------------
+//  This file is part of
+/// ---     Timothy Budd's Kamin Interpreters in C++
+// -----------------------------------------------------------------------------
+/// Title: Definition-time optimiser
+///  Description:
+//    Optimizer rewrites the body of a function once, when it is defined, by
+//    folding integer arithmetic on constants, pruning the branches of if
+//    statements with constant conditions and inlining calls to small
+//    user-defined functions whose bodies call only primitives.  Each
+//    function knows how calls to it may be rewritten, see
+//    Function::optimize; calls to functions which do not are left as they
+//    are.
+//
+//    The rewritten body is wrapped in an OptimizedExpression which keeps the
+//    original.  The rewrites depend on the functions bound to the names
+//    called when the body was defined so the OptimizedExpression records
+//    these bindings and evaluates the original body instead once any of them
+//    has been set or shadowed by a new definition, see Environment::define.
+//
+//    An inlined call evaluates its arguments into an argument vector and
+//    evaluates the body of the function in the environment in which the
+//    function was defined, the parameters being read from the argument
+//    vector, so that no environment need be allocated for the call.
+// -----------------------------------------------------------------------------
+
+#ifndef Optimizer_H
+#define Optimizer_H
+
+#include "function.h"
+
+// -----------------------------------------------------------------------------
+/// Optimizer
+// -----------------------------------------------------------------------------
+class Optimizer
+{
+    //- A binding on which the rewrites depend and its value when the body
+    //  was defined
+    struct Dependency
+    {
+        //- The cell of the values list of the environment
+        ListNode* cell_;
+
+        //- The value
+        Expr value_;
+    };
+
+    //- The environment in which the function is defined
+    Environment* rho_;
+
+    //- The names of the parameters of the function
+    ListNode* params_;
+
+    //- The optimiser of the enclosing function, 0 for a definition
+    Optimizer* parent_;
+
+    //- Is this the body of an inlined call, the parameters being read from
+    //  the argument vector of the call?
+    int inlined_;
+
+    //- Does the body call only primitives, so that it may be inlined?
+    int leaf_;
+
+    //- The bindings on which the rewrites depend
+    Dependency* dependencies_;
+
+    //- Number of dependencies
+    int nDependencies_;
+
+    //- Capacity of the dependencies array
+    int capacity_;
+
+    //- Disallow copy and assignment
+    Optimizer(const Optimizer&);
+    void operator=(const Optimizer&);
+
+    //- Return the index of the parameter of this function, -1 if none
+    int parameter(const Symbol&);
+
+    //- Is the symbol a parameter of this or an enclosing function?
+    int isParameter(const Symbol&);
+
+    //- Return the function called by the head of a call and set cell to
+    //  its binding if it may be changed, return 0 if it is not known
+    Function* function(Expression* head, ListNode*& cell);
+
+    //- Record that the rewrites depend on the binding
+    void depend(ListNode* cell, Expression* value);
+
+public:
+
+    //- Construct for a function with the given parameters defined in rho
+    Optimizer(Environment* rho, ListNode* params);
+
+    //- Construct for a function with the given parameters defined within
+    //  the function being optimised
+    Optimizer(Optimizer& parent, ListNode* params);
+
+    //- Construct for the body of an inlined call
+    Optimizer(Environment* rho, ListNode* params, const int inlined);
+
+    //- Destructor
+    ~Optimizer();
+
+    //- Set target to the optimised body guarded by the bindings on which the
+    //  rewrites depend, or to the body itself if nothing was rewritten
+    void body(Expr& target, Expression*);
+
+    //- Set target to the optimised expression
+    void optimize(Expr& target, Expression*);
+
+    //- Set target to the call with the arguments from first on optimised,
+    //  or to the call itself if none were rewritten
+    void arguments(Expr& target, ListNode* call, const int first = 1);
+
+    //- Set target to the call of the user-defined function, inlined if the
+    //  body of the function calls only primitives
+    void inlineCall(Expr& target, UserFunction*, ListNode* call);
+
+    //- Record that the body calls a function other than a primitive
+    void notLeaf()
+    {
+        leaf_ = 0;
+    }
+
+    //- Return the value of the expression if it is a constant, otherwise 0
+    static Expression* constant(Expression*);
+};
+///- Optimizer
+
+
+// -----------------------------------------------------------------------------
+/// OptimizedExpression
+//    The optimised body of a function with the original it replaces
+// -----------------------------------------------------------------------------
+class OptimizedExpression
+:
+    public Expression
+{
+    //- The body as defined
+    Expr original_;
+
+    //- The body as optimised
+    Expr optimized_;
+
+    //- The cells of the bindings on which the optimised body depends
+    ListNode** cells_;
+
+    //- The values of the bindings when the body was optimised
+    Expr* values_;
+
+    //- Number of bindings
+    int nCells_;
+
+    //- The generation of the interpreter when the body was optimised
+    long generation_;
+
+    //- Disallow copy and assignment
+    OptimizedExpression(const OptimizedExpression&);
+    void operator=(const OptimizedExpression&);
+
+public:
+
+    //- Construct from components, the bindings are set by the Optimizer
+    OptimizedExpression(Expression* original, Expression* optimized);
+
+    //- Destructor
+    virtual ~OptimizedExpression();
+
+    //- Specialised type predicate
+    virtual OptimizedExpression* isOptimized();
+
+    //- Return the body as defined
+    Expression* original()
+    {
+        return original_();
+    }
+
+    //- Is the optimised body still valid?
+    int valid();
+
+    //- Evaluate the optimised body if valid, otherwise the original
+    virtual void eval(Expr&, Environment*, Environment*);
+
+    //- Print the body as defined
+    virtual void print();
+
+    friend class Optimizer;
+};
+///- OptimizedExpression
+
+
+// -----------------------------------------------------------------------------
+/// InlinedCall
+//    A call to a user-defined function with the body in place
+// -----------------------------------------------------------------------------
+class InlinedCall
+:
+    public Expression
+{
+    //- The call as defined
+    Expr call_;
+
+    //- The optimised arguments
+    List args_;
+
+    //- The body of the function with the parameters read from the argument
+    //  vector
+    Expr body_;
+
+    //- The environment in which the function was defined
+    Environment* context_;
+
+public:
+
+    //- Construct from components
+    InlinedCall(ListNode* call, ListNode* args, Expression*, Environment*);
+
+    //- Destructor
+    virtual ~InlinedCall();
+
+    //- Evaluate the arguments and then the body
+    virtual void eval(Expr&, Environment*, Environment*);
+
+    //- Print the call as defined
+    virtual void print();
+};
+///- InlinedCall
+
+
+// -----------------------------------------------------------------------------
+/// InlineParameter
+//    A parameter of an inlined function read from the argument vector of the
+//    innermost inlined call being evaluated on this thread
+// -----------------------------------------------------------------------------
+class InlineParameter
+:
+    public Symbol
+{
+    //- The index of the parameter
+    int index_;
+
+    //- The arguments of the innermost inlined call on this thread
+    inline static thread_local Arguments* frame_ = 0;
+
+public:
+
+    // -------------------------------------------------------------------------
+    /// Frame
+    //    Makes the arguments of an inlined call current for its lifetime
+    // -------------------------------------------------------------------------
+    class Frame
+    {
+        //- The arguments to restore
+        Arguments* previous_;
+
+        //- Disallow copy and assignment
+        Frame(const Frame&);
+        void operator=(const Frame&);
+
+    public:
+
+        //- Make the arguments current
+        Frame(Arguments& argv)
+        :
+            previous_(frame_)
+        {
+            frame_ = &argv;
+        }
+
+        //- Restore the previous arguments
+        ~Frame()
+        {
+            frame_ = previous_;
+        }
+    };
+    ///- Frame
+
+    //- Construct given the name and index of the parameter
+    InlineParameter(const std::string& name, const int index)
+    :
+        Symbol(name),
+        index_(index)
+    {}
+
+    //- Return the argument
+    virtual void eval(Expr&, Environment*, Environment*);
+};
+///- InlineParameter
+
+
+// -----------------------------------------------------------------------------
+#endif // Optimizer_H
+// -----------------------------------------------------------------------------
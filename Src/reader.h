@@ -34,6 +34,9 @@ protected:
     //- Current location in buffer
     const char* p_;
 
+    //- Set if the input ended within a statement
+    int truncated_;
+
     //- Print prompt
     void printPrimaryPrompt() const;
 
@@ -52,8 +55,8 @@ protected:
     //- Skip new lines
     void skipNewlines();
 
-    //- Read integer
-    int readInteger();
+    //- Read integer of any size, negated if negative is set
+    IntegerExpression* readInteger(const bool negative = false);
 
     //- Read symbol
     Symbol* readSymbol();
@@ -66,6 +69,17 @@ protected:
 
 public:
 
+    //- Construct null
+    ReaderClass()
+    :
+        p_(0),
+        truncated_(0)
+    {}
+
+    //- Destructor
+    virtual ~ReaderClass()
+    {}
+
     //- Print prompt and read next statement
     Expression* promptAndRead();
 };
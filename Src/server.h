@@ -0,0 +1,96 @@
+// -----------------------------------------------------------------------------
+//  This file is part of
+/// ---     Timothy Budd's Kamin Interpreters in C++
+// -----------------------------------------------------------------------------
+/// Title: Evaluation server
+///  Description:
+//    Server accepts connections on a Unix-domain socket and runs an
+//    independent interpreter session for each.  A poll thread receives the
+//    input of the idle sessions and, once a session holds a whole statement,
+//    hands it to one of a fixed pool of worker threads which reads, evaluates
+//    and prints the statement before returning the session.  Workers never
+//    wait for input, so slow or idle clients do not hold them.  A session is
+//    only ever served by one thread at a time.  The transcript of a session is
+//    the same as that of the interpreter run on a terminal.
+//
+//    The sessions share one process and are not isolated from faults: a
+//    statement that crashes the interpreter ends every session.  Nor is there
+//    a time limit on a statement, one that does not terminate holds its worker
+//    until the server is stopped.
+// -----------------------------------------------------------------------------
+
+#ifndef Server_H
+#define Server_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+/// Forward declarations
+// -----------------------------------------------------------------------------
+class Session;
+
+// -----------------------------------------------------------------------------
+/// Server
+// -----------------------------------------------------------------------------
+class Server
+{
+    //- Path of the socket
+    const std::string path_;
+
+    //- Number of worker threads
+    const int nWorkers_;
+
+    //- The listening socket
+    int listenFd_;
+
+    //- Pipe written to wake the poll thread
+    int wakeFds_[2];
+
+    //- Protects the queues below
+    std::mutex mutex_;
+
+    //- Signalled when a session is queued to run or the server stops
+    std::condition_variable runnable_;
+
+    //- Sessions with a whole statement received waiting for a worker
+    std::deque<Session*> runQueue_;
+
+    //- Sessions returned by the workers to wait for input
+    std::vector<Session*> returned_;
+
+    //- Set when the workers are to finish
+    bool stopping_;
+
+    //- Disallow copy and assignment
+    Server(const Server&);
+    void operator=(const Server&);
+
+    //- Queue a session to be run by a worker
+    void schedule(Session*);
+
+    //- Return a session to the poll thread to wait for input
+    void release(Session*);
+
+    //- Worker thread loop
+    void work();
+
+public:
+
+    //- Construct serving on the socket path with the number of workers
+    Server(const std::string& path, const int nWorkers);
+
+    //- Destructor, removes the socket
+    ~Server();
+
+    //- Serve until interrupted or terminated, return the exit status
+    int run();
+};
+///- Server
+
+// -----------------------------------------------------------------------------
+#endif // Server_H
+// -----------------------------------------------------------------------------
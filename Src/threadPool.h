@@ -0,0 +1,208 @@
+// -----------------------------------------------------------------------------
+//  This file is part of
+/// ---     Timothy Budd's Kamin Interpreters in C++
+// -----------------------------------------------------------------------------
+/// Title: Futures and the work-stealing thread pool
+///  Description:
+//    Future is an expression whose value is computed by a task run on the
+//    process-wide ThreadPool.  Touching a future returns its value, running
+//    the task on the touching thread if no worker has started it yet, so
+//    waiting for a future never blocks on a task which is not running.
+//
+//    Each pool worker owns a double-ended queue: futures submitted by a
+//    worker are pushed onto and popped from the back of its own queue and
+//    idle workers steal from the front of the others.  Futures submitted by
+//    other threads are placed on a shared injection queue.
+//
+//    While futures of an interpreter are outstanding the expressions of the
+//    interpreter are shared between threads so the submitting thread and the
+//    workers update reference counts atomically, see
+//    Expression::setConcurrent.  Interpreter::waitForTasks, called at the
+//    end of every statement, returns the submitting thread to plain
+//    reference counting once all the tasks have released their expressions.
+//    Besides reference counting only the environments without a parent are
+//    synchronised, so that new global variables may be defined while futures
+//    run, see Environment.  Futures must not set variables used by other
+//    threads while they run.
+// -----------------------------------------------------------------------------
+
+#ifndef ThreadPool_H
+#define ThreadPool_H
+
+#include "expression.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+/// Forward declarations
+// -----------------------------------------------------------------------------
+class Interpreter;
+
+// -----------------------------------------------------------------------------
+/// Future
+// -----------------------------------------------------------------------------
+class Future
+:
+    public Expression
+{
+    //- States of the task
+    enum State
+    {
+        queued,
+        running,
+        done
+    };
+
+    //- The interpreter in which the task is evaluated
+    Interpreter& interpreter_;
+
+    //- The state of the task
+    std::atomic<int> state_;
+
+    //- The reference held by the queue of the pool, keeping the future
+    //  alive until it has been taken from the queue
+    Expr queued_;
+
+    //- The value, set when the task is done
+    Expr value_;
+
+    //- Protects the completion of the task
+    std::mutex mutex_;
+
+    //- Signalled when the task is done
+    std::condition_variable done_;
+
+    //- Disallow copy and assignment
+    Future(const Future&);
+    void operator=(const Future&);
+
+    //- Claim the task to run it, return 0 if it has already been claimed
+    int claim();
+
+    //- Run the claimed task
+    void run();
+
+    friend class ThreadPool;
+
+protected:
+
+    //- Compute the value, called on the thread running the task with the
+    //  interpreter active
+    virtual void compute(Expr&) = 0;
+
+public:
+
+    //- Construct for the interpreter active on this thread
+    Future();
+
+    //- Destructor
+    virtual ~Future();
+
+    //- Queue the task on the pool
+    void submit();
+
+    //- Return the value, waiting for or running the task
+    virtual Expression* touch();
+
+    //- Print
+    virtual void print();
+};
+///- Future
+
+
+// -----------------------------------------------------------------------------
+/// ThreadPool
+// -----------------------------------------------------------------------------
+class ThreadPool
+{
+    // -------------------------------------------------------------------------
+    /// Queue
+    //    A double-ended queue of futures protected by a mutex
+    // -------------------------------------------------------------------------
+    class Queue
+    {
+        //- Protects the futures
+        std::mutex mutex_;
+
+        //- The futures
+        std::deque<Future*> futures_;
+
+    public:
+
+        //- Push a future onto the back
+        void push(Future*);
+
+        //- Pop a future from the back, return 0 if empty
+        Future* popBack();
+
+        //- Pop a future from the front, return 0 if empty
+        Future* popFront();
+    };
+    ///- Queue
+
+    //- The queues of the workers followed by the injection queue
+    std::vector<Queue*> queues_;
+
+    //- The worker threads
+    std::vector<std::thread> workers_;
+
+    //- Number of queued futures
+    std::atomic<int> nQueued_;
+
+    //- Protects the sleep of idle workers
+    std::mutex mutex_;
+
+    //- Signalled when a future is queued or the pool stops
+    std::condition_variable queued_;
+
+    //- Set when the workers are to finish
+    bool stopping_;
+
+    //- The index of the worker running on this thread, -1 for other threads
+    inline static thread_local int worker_ = -1;
+
+    //- Disallow copy and assignment
+    ThreadPool(const ThreadPool&);
+    void operator=(const ThreadPool&);
+
+    //- Construct with the number of workers
+    ThreadPool(const int nWorkers);
+
+    //- Destructor, stops the workers
+    ~ThreadPool();
+
+    //- Take a future from the queues, own queue first, return 0 if none
+    Future* take();
+
+    //- Run the future taken from a queue and release the queue's reference
+    static void execute(Future*);
+
+    //- Worker thread loop
+    void work(const int index);
+
+public:
+
+    //- Return the pool, starting it on first use.  The number of workers is
+    //  given by the environment variable KAMIN_THREADS, by default the
+    //  number of hardware threads.
+    static ThreadPool& instance();
+
+    //- Return the number of workers
+    int size() const
+    {
+        return workers_.size();
+    }
+
+    //- Queue a future
+    void submit(Future*);
+};
+///- ThreadPool
+
+
+// -----------------------------------------------------------------------------
+#endif // ThreadPool_H
+// -----------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+#  This file is part of
+# ---     Timothy Budd's Kamin Interpreters in C++
+# -----------------------------------------------------------------------------
+# Title: Evaluation server test
+#  Description:
+#    Starts an interpreter as a server and runs several sessions on it at once,
+#    each sending its statements a few lines at a time interleaved with the
+#    others.  Every session must receive the same transcript as the interpreter
+#    run on the same input on its standard streams, so the sessions neither see
+#    each other's variables nor are disturbed by each other's errors.
+#
+#    Usage: server.py <interpreter> <test script> ...
+# -----------------------------------------------------------------------------
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+# Number of worker threads of the server
+nWorkers = 2
+
+# Number of sessions running each test script at once
+nCopies = 2
+
+# Lines sent at a time, between which the other sessions send theirs
+nLines = 5
+
+# Seconds allowed for the server to start and for each session to finish
+timeout = 60
+
+
+def sessions(scripts):
+    """The input of each session: the test scripts and short sessions of
+    their own, setting the same variable and failing part of the way"""
+    inputs = []
+    for script in scripts:
+        with open(script, 'rb') as f:
+            inputs += [f.read()]*nCopies
+    for i in range(nWorkers + 1):
+        inputs.append(
+            b"(set x %d)\n(car '())\n(car 7)\nx\n(set x (+ x 1))\nx\nquit\n"
+            % i)
+    return inputs
+
+
+def transcript(interpreter, data):
+    """The transcript of the interpreter run on the standard streams"""
+    return subprocess.run(
+        [interpreter], input=data, stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT, timeout=timeout).stdout
+
+
+def run(path, data, result, i):
+    """Run one session, storing its transcript in result[i]"""
+    client = socket.socket(socket.AF_UNIX)
+    client.settimeout(timeout)
+    client.connect(path)
+
+    def send():
+        lines = data.splitlines(True)
+        try:
+            for j in range(0, len(lines), nLines):
+                client.sendall(b''.join(lines[j:j + nLines]))
+                time.sleep(0.001)
+            client.shutdown(socket.SHUT_WR)
+        except OSError:
+            pass    # the session has ended at a quit
+
+    sender = threading.Thread(target=send)
+    sender.start()
+
+    received = []
+    try:
+        while True:
+            block = client.recv(65536)
+            if not block:
+                break
+            received.append(block)
+    except OSError as e:
+        received.append(b'\n[%s]\n' % str(e).encode())
+    sender.join()
+    client.close()
+    result[i] = b''.join(received)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit('Usage: server.py <interpreter> <test script> ...')
+    interpreter = sys.argv[1]
+    inputs = sessions(sys.argv[2:])
+
+    with tempfile.TemporaryDirectory() as dir:
+        path = os.path.join(dir, 'socket')
+        server = subprocess.Popen(
+            [interpreter, '-server', path, '-workers', str(nWorkers)])
+        try:
+            start = time.time()
+            while not os.path.exists(path):
+                if server.poll() is not None or time.time() - start > timeout:
+                    sys.exit('server failed to start')
+                time.sleep(0.01)
+
+            result = [None]*len(inputs)
+            clients = [
+                threading.Thread(target=run, args=(path, data, result, i))
+                for i, data in enumerate(inputs)
+            ]
+            for client in clients:
+                client.start()
+            for client in clients:
+                client.join()
+
+            if server.poll() is not None:
+                sys.exit('server exited with status %d' % server.returncode)
+        finally:
+            server.terminate()
+            server.wait()
+
+    nFailed = 0
+    for i, data in enumerate(inputs):
+        if result[i] != transcript(interpreter, data):
+            print('session %d: transcript differs from %s' % (i, interpreter))
+            nFailed += 1
+
+    if nFailed:
+        sys.exit('%d of %d sessions failed' % (nFailed, len(inputs)))
+
+
+if __name__ == '__main__':
+    main()
@@ -411,6 +411,112 @@
       (exp 4 3)
       ))
 '(double 8 exp 64)
+; Arbitrary-precision integers
+(define fact (n) (if (= n 0) 1 (* n (fact (- n 1)))))
+(fact 20)
+2432902008176640000
+(fact 25)
+15511210043330985984000000
+(/ (fact 25) (fact 23))
+600
+(- (fact 25) (fact 25))
+0
+(+ 9223372036854775807 1)
+9223372036854775808
+(- -9223372036854775807 2)
+-9223372036854775809
+(* 4294967296 4294967296)
+18446744073709551616
+(< (fact 25) (fact 26))
+'T
+(= (* (fact 22) 23) (fact 23))
+'T
+123456789012345678901234567890
+123456789012345678901234567890
+; Memoisation and hash-consing
+(define fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+(set fib (memo fib))
+(fib 80)
+23416728348467685
+(fib 10)
+55
+(= '(a (b 1) c) '(a (b 1) c))
+'T
+(= '(a (b 1) c) '(a (b 2) c))
+'()
+(= '() '())
+'T
+(hash-cons 'T)
+'T
+(= (cons 'a '(b)) '(a b))
+'T
+(hash-cons '())
+'()
+(= (cons 'a '(b)) '(a b))
+'T
+; Optimisation of function bodies, which is off by default
+(optimize 'T)
+'T
+; integer arithmetic on constants is folded and small functions inlined
+(define sq (x) (* x x))
+(define f (y) (+ (sq y) (* 2 3)))
+(f 4)
+22
+; only nil is false, so a constant integer or nil condition selects the
+; branch when the function is defined; comparisons are not folded
+(define g (x) (if (- 2 2) x (/ x 0)))
+(g 5)
+5
+(define h (x) (if '() (/ x 0) (- x (+ 1 1))))
+(h 5)
+3
+(define m (x) (if (> x (* 2 3)) (sq x) x))
+(m 7)
+49
+(m 3)
+3
+; the bodies of while, set and begin are optimised too
+(define sum (n) (begin (set s (- 1 1))
+    (while (> n 0) (begin (set s (+ s (sq n))) (set n (- n (* 1 1)))))
+    s))
+(sum 4)
+30
+; redefining an inlined function
+(define sq (x) (+ x x))
+(f 4)
+14
+(sum 4)
+20
+; setting an inlined function to another function
+(define inc (x) (+ x 1))
+(define k (x) (* (inc x) (inc x)))
+(k 2)
+9
+(define dbl (x) (+ x x))
+(set inc dbl)
+(k 2)
+16
+; d no longer calls a function, so the call reports an error
+(define dec (x) (- x 1))
+(define d (x) (dec x))
+(d 5)
+4
+(set dec 'x)
+'x
+(d 5)
+(define dec (x) (- x 2))
+(d 5)
+3
+(optimize '())
+'()
+(define p (x) (sq x))
+(p 3)
+6
+;
+; car and cdr of the empty list report an error
+(car '())
+(car (cdr '(1)))
+(cdr '())
 quit
 (r-e-p-loop '(
   (define cadr (exp) (car (cdr exp)))